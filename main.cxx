@@ -14,12 +14,30 @@
 
 /*
 	Para aumentar el efecto de puntillismo, puede variar el valor
-	de 'GRANULADO' en la linea 48 de este archivo, puede variarla
-	entre 1 y 3 recomendadamente.
+	de 'GRANULADO' con '--granulado N', puede variarlo entre 1 y 3
+	recomendadamente.
 
-	El valor de 'SECTION' en la linea 49, controla el tamaño del
+	El valor de 'SECTION' ('--section N') controla el tamaño del
 	dibujo, puede variarlo entre 20 y 80 recomendadamente, pero
 	el tamaño por defecto y recomendado es 56.
+
+	'--paleta N' escoge una de las paletas de 'PALETAS'.
+*/
+
+/*
+	Multitud: './totoro --multitud N' dibuja N copias del personaje
+	a partir de una sola nube de puntos, generada una vez por cada
+	GRANULADO/semilla ('--semilla S'). Con '--cpu archivo.ppm' la
+	multitud se dibuja sin ventana y se guarda en una imagen PPM.
+*/
+
+/*
+	Lote: './totoro --lote trabajos.txt' dibuja sin ventana cada linea
+	'section granulado semilla paleta salida.ppm' del archivo. Con
+	'--barrido' los trabajos salen de los rangos 'desde:hasta[:paso]'
+	de '--section', '--granulado', '--semilla' y '--paleta', y se
+	guardan en el directorio de '--salida'. Los trabajos se reparten
+	entre todos los nucleos y comparten la geometria de cada SECTION.
 */
 
 /***********************************************************************
@@ -27,39 +45,185 @@
 ***********************************************************************/
 
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <tuple>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <sstream>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 #include <math.h>
 #include <GL/freeglut.h>
 #include <GL/gl.h>
 
-#define COLOR_FONDO 		HSL(122, 11, 47, true)
-#define COLOR_NARIZ 		HSL(0, 0, 20)
-#define COLOR_SOMBRA 		HSL(127, 11, 33)
-#define COLOR_SOMBRA_CLARA 	HSL(127, 11, 70)
-#define COLOR_CONTORNO	 	HSL(120, 19, 8)
-#define COLOR_BLANCO 		HSL(0, 0, 96)
+enum Color { FONDO, NARIZ, SOMBRA, SOMBRA_CLARA, CONTORNO, BLANCO, COLORES };
+
+// H, S, L de cada color, una fila por paleta
+const float PALETAS[][COLORES][3] = {
+	{{122, 11, 47}, {0, 0, 20}, {127, 11, 33}, {127, 11, 70}, {120, 19, 8}, {0, 0, 96}},		// ORIGINAL
+	{{225, 30, 22}, {230, 15, 10}, {225, 25, 15}, {220, 20, 55}, {230, 40, 5}, {210, 30, 92}},	// NOCHE
+	{{28, 45, 42}, {15, 20, 18}, {25, 40, 30}, {35, 50, 70}, {20, 35, 8}, {40, 60, 94}},		// OTOÑO
+};
+#define TOTAL_PALETAS	(int)(sizeof(PALETAS) / sizeof(PALETAS[0]))
+
+#define COLOR_FONDO 		color(FONDO, true)
+#define COLOR_NARIZ 		color(NARIZ)
+#define COLOR_SOMBRA 		color(SOMBRA)
+#define COLOR_SOMBRA_CLARA 	color(SOMBRA_CLARA)
+#define COLOR_CONTORNO	 	color(CONTORNO)
+#define COLOR_BLANCO 		color(BLANCO)
 
-#define GROSOR_CONTORNO	glPointSize(3)
-#define GROSOR_MEDIO 	glPointSize(2)
-#define GROSOR_SOMBRA 	glPointSize(1)
+#define GROSOR_CONTORNO	grosor(3)
+#define GROSOR_MEDIO 	grosor(2)
+#define GROSOR_SOMBRA 	grosor(1)
 
-#define GRANULADO 	1 	// MIN 1 - MAX 3
-#define SECTION 	56	// MIN 20 - MAX 80 - (Recomendado 56)
+/*
+	Son por hilo para que el modo lote pueda dibujar varias
+	combinaciones de SECTION/GRANULADO/paleta al mismo tiempo.
+*/
+thread_local int granulado = 1; 	// MIN 1 - MAX 3
+thread_local int section = 56;		// MIN 20 - MAX 80 - (Recomendado 56)
+thread_local int paleta = 0;
+
+#define GRANULADO 	granulado
+#define SECTION 	section
+#define SECTION_MAXIMA	80		// Limite de --section y del modo lote
 #define WIDTH 		SECTION * 27
 #define HEIGHT 		SECTION * 11
 
+/*
+	Compilando con -DGEOMETRIA_FIJA toda la geometria usa 'Fijo' en vez
+	de float, incluidos los contadores de los ciclos.
+*/
+#ifdef GEOMETRIA_FIJA
+
+/*
+	Numero en punto fijo 16.16 para la geometria. Solo usa enteros, asi
+	que los puntos generados son identicos bit a bit con cualquier
+	compilador y nivel de optimizacion. Los valores deben estar en
+	(-32768, 32768): las distancias al cuadrado de circle_band() y
+	crescent() desbordan con SECTION cerca de 95, por encima de
+	SECTION_MAXIMA.
+*/
+struct Fijo {
+	int32_t raw;
+
+	Fijo() : raw(0) {}
+	Fijo(int v) : raw(v * 65536) {}
+	Fijo(double v) : raw((int32_t)floor(v * 65536 + 0.5)) {}
+
+	static Fijo from_raw(int64_t v) { Fijo f; f.raw = (int32_t)v; return f; }
+	explicit operator float() const { return raw / 65536.0f; }
+
+	friend Fijo operator+(Fijo a, Fijo b) { return from_raw(a.raw + b.raw); }
+	friend Fijo operator-(Fijo a, Fijo b) { return from_raw(a.raw - b.raw); }
+	friend Fijo operator*(Fijo a, Fijo b) { return from_raw(((int64_t)a.raw * b.raw) >> 16); }
+	friend Fijo operator/(Fijo a, Fijo b) {
+		if(b.raw == 0) return from_raw(a.raw < 0 ? INT32_MIN : INT32_MAX);
+		return from_raw((int64_t)a.raw * 65536 / b.raw);
+	}
+	Fijo operator-() const { return from_raw(-raw); }
+	Fijo& operator+=(Fijo b) { raw += b.raw; return *this; }
+	Fijo& operator-=(Fijo b) { raw -= b.raw; return *this; }
+	Fijo& operator++() { raw += 65536; return *this; }
+	Fijo operator++(int) { Fijo f = *this; raw += 65536; return f; }
+
+	friend bool operator<(Fijo a, Fijo b) { return a.raw < b.raw; }
+	friend bool operator>(Fijo a, Fijo b) { return a.raw > b.raw; }
+	friend bool operator<=(Fijo a, Fijo b) { return a.raw <= b.raw; }
+	friend bool operator>=(Fijo a, Fijo b) { return a.raw >= b.raw; }
+	friend bool operator==(Fijo a, Fijo b) { return a.raw == b.raw; }
+	friend bool operator!=(Fijo a, Fijo b) { return a.raw != b.raw; }
+};
+
+Fijo fabs(Fijo a);
+Fijo floor(Fijo a);
+Fijo sqrt(Fijo a);
+Fijo cos(Fijo a);
+Fijo sin(Fijo a);
+
+typedef Fijo real;
+#define GEOMETRIA "16.16"
+#else
+typedef float real;
+#define GEOMETRIA "float"
+#endif
+
+const real PI = 3.14159265358979;
+
+struct Punto {
+	float x, y;
+	float size;
+	int color;		// Indice en la paleta, asi la geometria sirve para cualquier paleta
+};
+
+// Puntos consecutivos con el mismo grosor y color, para glDrawArrays
+struct Tramo {
+	float size;
+	int color;
+	int inicio, cantidad;
+};
+
+struct Nube {
+	std::vector<Punto> puntos;
+	float x_min, y_min, x_max, y_max;
+
+	std::vector<float> vertices;	// x, y de cada punto, para glVertexPointer
+	std::vector<Tramo> tramos;
+};
+
+struct Instancia {
+	float x, y;		// Desplazamiento del origen del dibujo
+	float escala;
+	float R, G, B;	// Tinte [0 - 1] que multiplica el color de cada punto
+};
+
+/*
+	Mientras 'captura' no sea NULL, p() guarda todos los puntos en la
+	nube, sin puntillismo, en lugar de enviarlos a OpenGL, junto con el
+	color y grosor actuales.
+*/
+thread_local Nube* captura = NULL;
+thread_local int color_actual = CONTORNO;
+thread_local float grosor_actual = 1;
+
+void color(int slot, bool fondo = false);
+void hsl_to_rgb(float H, float S, float L, float rgb[3]);
 void HSL(float H, float S, float L, bool fondo = false);
 void RGB(float R, float G, float B, bool fondo = false);
-void p(float x, float y);
-void circle(float x, float y, float radius, bool filled = false);
-void circleIn(float x, float y, float radius, float g1, float g2);
-void elipse(float x, float y, float radius_x, float radius_y);
-float value_of_curve(float x, float y, float H, float K, float value);
-void semi_curve(float x, float y, float H, float K);
-void curve(float x_i, float y_i, float x_f, float y_f, float H, float K);
-void line(float x_i, float y_i, float x_f, float y_f);
+void grosor(float size);
+void begin_points();
+void end_points();
+void p(real x, real y);
+void circle(real x, real y, real radius, bool filled = false);
+void circleIn(real x, real y, real radius, real g1, real g2);
+void elipse(real x, real y, real radius_x, real radius_y);
+struct Parabola {
+	real H, K;			// Vertice
+	real ancho, alto;	// (x - H) y (y - K) del punto por donde pasa
+};
+
+Parabola parabola(real x, real y, real H, real K);
+real curve_at(const Parabola& curva, real value);
+real value_of_curve(real x, real y, real H, real K, real value);
+void semi_curve(real x, real y, real H, real K);
+void curve(real x_i, real y_i, real x_f, real y_f, real H, real K);
+void line(real x_i, real y_i, real x_f, real y_f);
+void parabola_band(const Parabola& izquierda, const Parabola& derecha, real x_Menor, real x_Mayor, real width);
+void semi_curve_band(real x, real y, real H, real K, real width);
+void curve_band(real x_i, real y_i, real x_f, real y_f, real H, real K, real width);
+void circle_band(real x, real y, real radius, real width);
+void crescent(real x_0, real x_1, real y, real radius);
+void line_band(real x_i, real y_i, real x_f, real y_f, real width_i, real width_f);
 
 float mod(float a, float b) {
 	int res = a/b;
@@ -81,8 +245,10 @@ float mod(float a, float b) {
 	L: Lightness [0 - 100]
 
 	Colour wheel for HSL: https://bitsofco.de/img/blog/26/hsl.png
+
+	rgb: [0 - 1]
 */
-void HSL(float H, float S, float L, bool fondo) {
+void hsl_to_rgb(float H, float S, float L, float rgb[3]) {
 	H /= 60;
 	S /= 100;
 	L /= 100;
@@ -104,65 +270,182 @@ void HSL(float H, float S, float L, bool fondo) {
 		case 5: R=C; G=0; B=X; break;
 	}
 
-	R = (R + m) * 255;
-	G = (G + m) * 255;
-	B = (B + m) * 255;
+	rgb[0] = R + m;
+	rgb[1] = G + m;
+	rgb[2] = B + m;
+}
+
+void HSL(float H, float S, float L, bool fondo) {
+	float rgb[3];
+	hsl_to_rgb(H, S, L, rgb);
+	RGB(rgb[0] * 255, rgb[1] * 255, rgb[2] * 255, fondo);
+}
 
-	RGB(R, G, B, fondo);
+void color(int slot, bool fondo) {
+	const float* hsl = PALETAS[paleta][slot];
+	if(!fondo) color_actual = slot;
+	HSL(hsl[0], hsl[1], hsl[2], fondo);
+}
+
+void palette(int indice, float colores[COLORES][3]) {
+	for(int i = 0; i < COLORES; i++) {
+		hsl_to_rgb(PALETAS[indice][i][0], PALETAS[indice][i][1], PALETAS[indice][i][2], colores[i]);
+	}
 }
 
 void RGB(float R, float G, float B, bool fondo) {
+	if(captura) return;
+
 	if(fondo) glClearColor(R/255.0, G/255.0, B/255.0, 1.0);
 	else glColor4f(R/255.0, G/255.0, B/255.0, 1.0);
 }
 
+void grosor(float size) {
+	grosor_actual = size;
+	if(!captura) glPointSize(size);
+}
+
+void begin_points() {
+	if(!captura) glBegin(GL_POINTS);
+}
+
+void end_points() {
+	if(!captura) glEnd();
+}
+
+/***********************************************************************
+	FIXED POINT FUNCTIONS
+***********************************************************************/
+
+#ifdef GEOMETRIA_FIJA
+
+#define FIJO_PI			205887	// PI * 65536
+#define FIJO_MEDIO_PI	102944
+#define FIJO_DOS_PI		411775
+#define CORDIC_K		39797	// Producto de cos(atan(2^-i)) * 65536
+
+// atan(2^-i) * 65536
+const int32_t CORDIC_ATAN[16] = {
+	51472, 30386, 16055, 8150, 4091, 2047, 1024, 512, 256, 128, 64, 32, 16, 8, 4, 2
+};
+
+Fijo fabs(Fijo a) {
+	return a.raw < 0 ? -a : a;
+}
+
+Fijo floor(Fijo a) {
+	return Fijo::from_raw(a.raw - (a.raw & 0xFFFF));
+}
+
+Fijo sqrt(Fijo a) {
+	if(a.raw <= 0) return Fijo();
+
+	// Raiz entera de raw * 2^16, digito por digito
+	uint64_t n = (uint64_t)a.raw << 16;
+	uint64_t res = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while(bit > n) bit >>= 2;
+	while(bit != 0) {
+		if(n >= res + bit) {
+			n -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return Fijo::from_raw(res);
+}
+
+/*
+	CORDIC en modo rotacion: el angulo se reduce a [-PI/2, PI/2] y se
+	gira el vector (K, 0) hasta agotar el angulo.
+*/
+void sin_cos(Fijo a, Fijo& s, Fijo& c) {
+	int32_t z = a.raw % FIJO_DOS_PI;
+	int32_t signo = 1;
+
+	if(z > FIJO_PI) z -= FIJO_DOS_PI;
+	if(z < -FIJO_PI) z += FIJO_DOS_PI;
+	if(z > FIJO_MEDIO_PI) { z -= FIJO_PI; signo = -1; }
+	if(z < -FIJO_MEDIO_PI) { z += FIJO_PI; signo = -1; }
+
+	int64_t x = CORDIC_K, y = 0;
+	for(int i = 0; i < 16; i++) {
+		int64_t x_n = (z >= 0 ? x - (y >> i) : x + (y >> i));
+		int64_t y_n = (z >= 0 ? y + (x >> i) : y - (x >> i));
+		z += (z >= 0 ? -CORDIC_ATAN[i] : CORDIC_ATAN[i]);
+		x = x_n;
+		y = y_n;
+	}
+
+	c = Fijo::from_raw(x * signo);
+	s = Fijo::from_raw(y * signo);
+}
+
+Fijo cos(Fijo a) {
+	Fijo s, c;
+	sin_cos(a, s, c);
+	return c;
+}
+
+Fijo sin(Fijo a) {
+	Fijo s, c;
+	sin_cos(a, s, c);
+	return s;
+}
+
+#endif
+
 /***********************************************************************
 	SHAPE FUNCTIONS
 ***********************************************************************/
 
-void p(float x, float y) {
-	if((rand()%100)%GRANULADO == 0)
-		glVertex2f(x,y);
+void p(real x, real y) {
+	if(captura) {
+		Punto punto = {(float)x, (float)y, grosor_actual, color_actual};
+		captura->puntos.push_back(punto);
+	} else if((rand()%100)%GRANULADO == 0) {
+		glVertex2f((float)x, (float)y);
+	}
 }
 
-void circle(float x, float y, float radius, bool filled) {
-	glBegin(GL_POINTS);
-		for(float i = 0; i < 360; i++){
-			float grd = i * 2.0 * 3.1416 / 360;
-			for(float j = 0; j < radius && filled; j++) {
-				p(x + j * cos(i), y + j * sin(i));
+void circle(real x, real y, real radius, bool filled) {
+	begin_points();
+		for(real i = 0; i < 360; i++){
+			real grd = i * 2.0 * PI / 360;
+			real c = cos(i);
+			real s = sin(i);
+			for(real j = 0; j < radius && filled; j++) {
+				p(x + j * c, y + j * s);
 			}
-			p(x + radius * cos(i), y + radius * sin(i));
+			p(x + radius * c, y + radius * s);
 		}
-	glEnd();
+	end_points();
 }
 
-void circleIn(float x, float y, float radius, float g1, float g2) {
-	glBegin(GL_POINTS);
-		for(float i = g1; i < g2; i++){
-			float grd = i * 2.0 * 3.1416 / 360;
+void circleIn(real x, real y, real radius, real g1, real g2) {
+	begin_points();
+		for(real i = g1; i < g2; i++){
+			real grd = i * 2.0 * PI / 360;
 			p(x + radius * cos(grd), y + radius * sin(grd));
 		}
-	glEnd();
+	end_points();
 }
 
-void elipse(float x, float y, float radius_x, float radius_y) {
-	glBegin(GL_POINTS);
-		for(float i = 0; i < 360; i++){
+void elipse(real x, real y, real radius_x, real radius_y) {
+	begin_points();
+		for(real i = 0; i < 360; i++){
 			HSL(120, 100, 50);
-			float grd = i * 2.0 * 3.1416 / 360;
+			real grd = i * 2.0 * PI / 360;
 			p(x + radius_x * cos(i), y + radius_y * sin(i));
 		}
-	glEnd();
-}
-
-float value_of_curve(float x, float y, float H, float K, float value) {
-	float P = ((x - H)*(x - H)) / (4 * (y - K));
-
-	return ((4 * P * K) + ((value - H) * (value - H))) / (4 * P);
+	end_points();
 }
 
-void semi_curve(float x, float y, float H, float K) {
+real value_of_curve(real x, real y, real H, real K, real value) {
 	/*
 		Equation of the parabola with vertex (H, K) and passing through the point (x, y)
 
@@ -172,85 +455,250 @@ void semi_curve(float x, float y, float H, float K) {
 
 		P = (x - H)² / 4(y - K)
 
-		y(x) = (4PK + (x - H)²) / 4P
+		y(X) = (4PK + (X - H)²) / 4P = K + (y - K) * ((X - H) / (x - H))²
+
+		The last form keeps every intermediate value small, so it also
+		works in 16.16 fixed point.
 	*/
-	float P = ((x - H)*(x - H)) / (4 * (y - K));
+	return curve_at(parabola(x, y, H, K), value);
+}
+
+Parabola parabola(real x, real y, real H, real K) {
+	Parabola curva = {H, K, x - H, y - K};
+	return curva;
+}
+
+/*
+	Los rellenos evaluan cada curva una vez por columna. (y - K) / (x - H)²
+	no se guarda como un solo coeficiente porque en 16.16 quedaria con
+	muy pocos bits significativos (~0.001 para los labios).
+*/
+real curve_at(const Parabola& curva, real value) {
+	real t = (value - curva.H) / curva.ancho;
+
+	return curva.K + curva.alto * t * t;
+}
+
+void semi_curve(real x, real y, real H, real K) {
+	Parabola curva = parabola(x, y, H, K);
 
-	for(float X = (x < H ? x : H); X <= (x > H ? x : H); X++) {
-		float Y = ((4 * P * K) + ((X - H) * (X - H))) / (4 * P);
-		p(X, Y);
+	for(real X = (x < H ? x : H); X <= (x > H ? x : H); X++) {
+		p(X, curve_at(curva, X));
 	}
 }
 
-void curve(float x_i, float y_i, float x_f, float y_f, float H, float K) {
+void curve(real x_i, real y_i, real x_f, real y_f, real H, real K) {
 	semi_curve(x_i, y_i, H, K);
 	semi_curve(x_f, y_f, H, K);
 }
 
-void line(float x_i, float y_i, float x_f, float y_f) {
-	float m = (y_f - y_i) / (x_f - x_i);
-
-	float x_Mayor = (x_i > x_f ? x_i : x_f);
-	float x_Menor = (x_i < x_f ? x_i : x_f);
-	float y_Mayor = (y_i > y_f ? y_i : y_f);
-	float y_Menor = (y_i < y_f ? y_i : y_f);
+void line(real x_i, real y_i, real x_f, real y_f) {
+	real x_Mayor = (x_i > x_f ? x_i : x_f);
+	real x_Menor = (x_i < x_f ? x_i : x_f);
+	real y_Mayor = (y_i > y_f ? y_i : y_f);
+	real y_Menor = (y_i < y_f ? y_i : y_f);
 
 	if(x_i == x_f) {
-		for(float Y = y_i ; Y <= y_f; Y++) {
+		for(real Y = y_i ; Y <= y_f; Y++) {
 			p(x_i, Y);
 		}
 	} else if(y_i == y_f) {
-		for(float X = x_i ; X <= x_f; X++) {
+		for(real X = x_i ; X <= x_f; X++) {
 			p(X, y_i);
 		}
 	} else if(x_Mayor - x_Menor > y_Mayor - y_Menor) {
-		for(float X = x_Menor ; X <= x_Mayor; X++) {
-			float Y = m * (X - x_i) + y_i;
+		real m = (y_f - y_i) / (x_f - x_i);
+		for(real X = x_Menor ; X <= x_Mayor; X++) {
+			real Y = m * (X - x_i) + y_i;
 			p(X, Y);
 		}
 	} else {
-		for(float Y = y_Menor ; Y <= y_Mayor; Y++) {
-			float X = ((Y - y_i) + (m * x_i)) / m;
-			std::cout<<X<<","<<Y<<'\n';
+		real m = (x_f - x_i) / (y_f - y_i);
+		for(real Y = y_Menor ; Y <= y_Mayor; Y++) {
+			real X = m * (Y - y_i) + x_i;
 			p(X, Y);
 		}
 	}
 
 }
 
+/***********************************************************************
+	BAND FUNCTIONS
+***********************************************************************/
+
+/*
+	Trazos gruesos en una sola pasada: cada pixel del rectangulo que
+	contiene la figura se visita una vez y se dibuja si su distancia a
+	la figura es menor que la mitad del ancho, en lugar de repetir la
+	figura varias veces con el centro o el radio desplazado.
+*/
+
+/*
+	Banda de una parabola con el vertice en H: 'izquierda' se usa para
+	X < H y 'derecha' para el resto. Cada columna de [x_Menor, x_Mayor]
+	se recorre una vez, asi el vertice de curve_band() no se dibuja dos
+	veces, y los extremos redondeados solo salen por fuera del tramo.
+
+	Distancia aproximada a la parabola y(X) = K + alto ((X - H) / ancho)²
+
+		d = |Y - y(X)| / sqrt(1 + y'(X)²),  y'(X) = 2 alto (X - H) / ancho²
+*/
+void parabola_band(const Parabola& izquierda, const Parabola& derecha, real x_Menor, real x_Mayor, real width) {
+	real H = izquierda.H;
+	real K = izquierda.K;
+	real y_a = curve_at(x_Menor < H ? izquierda : derecha, x_Menor);
+	real y_b = curve_at(x_Mayor < H ? izquierda : derecha, x_Mayor);
+	real y_Menor = (y_a < y_b ? y_a : y_b);
+	real y_Mayor = (y_a > y_b ? y_a : y_b);
+	if(x_Menor <= H && H <= x_Mayor) {
+		y_Menor = (y_Menor < K ? y_Menor : K);
+		y_Mayor = (y_Mayor > K ? y_Mayor : K);
+	}
+	y_Menor = y_Menor - width / 2;
+	y_Mayor = y_Mayor + width / 2;
+
+	for(real X = floor(x_Menor - width / 2); X <= x_Mayor + width / 2; X++) {
+		if(X < x_Menor || X > x_Mayor) {
+			// Extremo redondeado
+			real x_e = (X < x_Menor ? x_Menor : x_Mayor);
+			real y_e = (X < x_Menor ? y_a : y_b);
+			for(real Y = floor(y_e - width / 2); Y <= y_e + width / 2; Y++) {
+				if((X - x_e) * (X - x_e) + (Y - y_e) * (Y - y_e) <= width * width / 4)
+					p(X, Y);
+			}
+		} else {
+			// d <= width / 2  <=>  |Y - y(X)| <= width / 2 * sqrt(1 + y'(X)²)
+			const Parabola& curva = (X < H ? izquierda : derecha);
+			real y_c = curve_at(curva, X);
+			real dy = 2 * curva.alto * ((X - H) / curva.ancho) / curva.ancho;
+			real limite = width / 2 * sqrt(1 + dy * dy);
+			for(real Y = floor(y_c - limite); Y <= y_c + limite; Y++) {
+				if(y_Menor <= Y && Y <= y_Mayor && fabs(Y - y_c) <= limite)
+					p(X, Y);
+			}
+		}
+	}
+}
+
+void semi_curve_band(real x, real y, real H, real K, real width) {
+	Parabola curva = parabola(x, y, H, K);
+	parabola_band(curva, curva, (x < H ? x : H), (x > H ? x : H), width);
+}
+
+void curve_band(real x_i, real y_i, real x_f, real y_f, real H, real K, real width) {
+	parabola_band(parabola(x_i, y_i, H, K), parabola(x_f, y_f, H, K),
+		(x_i < x_f ? x_i : x_f), (x_i > x_f ? x_i : x_f), width);
+}
+
+void circle_band(real x, real y, real radius, real width) {
+	// |d - radius| <= width / 2, comparando distancias al cuadrado
+	real r = radius + width / 2;
+	real r_min = radius - width / 2;
+
+	for(real X = floor(x - r); X <= x + r; X++) {
+		for(real Y = floor(y - r); Y <= y + r; Y++) {
+			real d = (X - x) * (X - x) + (Y - y) * (Y - y);
+			if(d <= r * r && d >= r_min * r_min)
+				p(X, Y);
+		}
+	}
+}
+
+/*
+	Region que barre la mitad derecha de la circunferencia de radio
+	'radius' cuando su centro se mueve de (x_1, y) a (x_0, y): dentro
+	del circulo en x_0 y fuera del circulo en x_1.
+*/
+void crescent(real x_0, real x_1, real y, real radius) {
+	real r_0 = radius + 0.5;
+	real r_1 = radius - 0.5;
+
+	for(real X = floor(x_1); X <= x_0 + r_0; X++) {
+		for(real Y = floor(y - r_0); Y <= y + r_0; Y++) {
+			real d_0 = (X - x_0) * (X - x_0) + (Y - y) * (Y - y);
+			real d_1 = (X - x_1) * (X - x_1) + (Y - y) * (Y - y);
+			if(d_0 <= r_0 * r_0 && d_1 >= r_1 * r_1)
+				p(X, Y);
+		}
+	}
+}
+
+/*
+	Segmento cuyo ancho cambia linealmente de 'width_i' a 'width_f',
+	como el abanico de lineas de los bigotes y las pestañas.
+*/
+void line_band(real x_i, real y_i, real x_f, real y_f, real width_i, real width_f) {
+	real w = (width_i > width_f ? width_i : width_f) / 2;
+	real dx = x_f - x_i;
+	real dy = y_f - y_i;
+
+	// Direccion escalada para que dx² + dy² no desborde en punto fijo
+	real escala = (fabs(dx) > fabs(dy) ? fabs(dx) : fabs(dy));
+	if(escala == 0) escala = 1;
+	real u_x = dx / escala;
+	real u_y = dy / escala;
+	real largo = escala * (u_x * u_x + u_y * u_y);
+
+	real x_Menor = (x_i < x_f ? x_i : x_f) - w;
+	real x_Mayor = (x_i > x_f ? x_i : x_f) + w;
+	real y_Menor = (y_i < y_f ? y_i : y_f) - w;
+	real y_Mayor = (y_i > y_f ? y_i : y_f) + w;
+
+	for(real X = floor(x_Menor); X <= x_Mayor; X++) {
+		for(real Y = floor(y_Menor); Y <= y_Mayor; Y++) {
+			real t = ((X - x_i) * u_x + (Y - y_i) * u_y) / largo;
+			t = (t < 0 ? 0 : (t > 1 ? 1 : t));
+
+			real x_c = x_i + t * dx;
+			real y_c = y_i + t * dy;
+			if(fabs(X - x_c) > w || fabs(Y - y_c) > w) continue;
+
+			real d = (X - x_c) * (X - x_c) + (Y - y_c) * (Y - y_c);
+			real w_t = (width_i + t * (width_f - width_i)) / 2;
+			if(d <= w_t * w_t)
+				p(X, Y);
+		}
+	}
+}
+
 /***********************************************************************
 	DRAW PARTS FUNCTIONS
 ***********************************************************************/
 
 void pelos() {
-	float x_i = SECTION * 12;
-	float x_f = x_i + SECTION * 3;
-	float y = SECTION * 7.3;
+	real x_i = SECTION * 12;
+	real x_f = x_i + SECTION * 3;
+	real y = SECTION * 7.3;
+
+	// Limites y curvas del relleno, calculados una vez
+	real x_m = x_i + SECTION * 1.5;
+	real x_a = x_i + SECTION * 0.2;
+	real x_b = x_f - SECTION * 0.2;
+	real y_min = y - SECTION * 0.25;
+	real y_max = y + SECTION * 0.6;
+
+	Parabola superior_i = parabola(x_i, y, x_m, y_max);
+	Parabola superior_f = parabola(x_f, y, x_m, y_max);
+	Parabola punta_i = parabola(x_i, y, x_a, y_min);
+	Parabola punta_f = parabola(x_f, y, x_b, y_min);
+	Parabola inferior_i = parabola(x_i, y - SECTION * 0.3, x_m, y + SECTION * 0.20);
+	Parabola inferior_f = parabola(x_f, y - SECTION * 0.3, x_m, y + SECTION * 0.20);
 
 	COLOR_SOMBRA;
 	GROSOR_SOMBRA;
-	glBegin(GL_POINTS);
-
-		for(float i = x_i; i <= x_f; i++) {
-			for(float j = y - SECTION * 0.25; j <= y + SECTION * 0.6; j++) {
-				float v_s, v_i;
-				if(i < x_i + SECTION * 1.5) {
-					if(i < x_i + SECTION * 0.2) {
-						v_s = value_of_curve(x_i, y, x_i + SECTION * 1.5, y + SECTION * 0.6, i);
-						v_i = value_of_curve(x_i, y, x_i + SECTION * 0.2, y - SECTION * 0.25, i);
-					} else {
-						v_s = value_of_curve(x_i, y, x_i + SECTION * 1.5, y + SECTION * 0.6, i);
-						v_i = value_of_curve(x_i, y - SECTION * 0.3, x_i + SECTION * 1.5, y + SECTION * 0.20, i);
-					}
-				} else {
-					if(i >= x_f - SECTION * 0.2) {
-						v_s = value_of_curve(x_f, y, x_i + SECTION * 1.5, y + SECTION * 0.6, i);
-						v_i = value_of_curve(x_f, y, x_f - SECTION * 0.2, y - SECTION * 0.25, i);
-					} else {
-						v_s = value_of_curve(x_f, y, x_i + SECTION * 1.5, y + SECTION * 0.6, i);
-						v_i = value_of_curve(x_f, y - SECTION * 0.3, x_i + SECTION * 1.5, y + SECTION * 0.20, i);
-					}
-				}
+	begin_points();
+
+		for(real i = x_i; i <= x_f; i++) {
+			real v_s, v_i;
+			if(i < x_m) {
+				v_s = curve_at(superior_i, i);
+				v_i = curve_at(i < x_a ? punta_i : inferior_i, i);
+			} else {
+				v_s = curve_at(superior_f, i);
+				v_i = curve_at(i >= x_b ? punta_f : inferior_f, i);
+			}
+
+			for(real j = y_min; j <= y_max; j++) {
 				if(v_i < j && j < v_s)
 					p(i, j);
 			}
@@ -270,73 +718,81 @@ void pelos() {
 		
 		semi_curve(x_f, y, x_i + SECTION * 2.5, y + SECTION * 0.1);*/
 		
-	glEnd();
+	end_points();
 }
 
 void nariz() {
-	float x_i = SECTION * 12;
-	float x_f = x_i + SECTION * 3;
-	float y = SECTION * 7;
+	real x_i = SECTION * 12;
+	real x_f = x_i + SECTION * 3;
+	real y = SECTION * 7;
+
+	// Limites y curvas del relleno, calculados una vez
+	real x_a = x_i + SECTION * 0.4;
+	real x_b = x_i + SECTION * 0.8;
+	real x_c = x_i + SECTION * 1.2;
+	real x_m = x_i + SECTION * 1.5;
+	real x_d = x_f - SECTION * 1.2;
+	real x_e = x_f - SECTION * 0.8;
+	real x_g = x_f - SECTION * 0.4;
+	real y_min = y - SECTION * 0.5;
+	real y_max = y + SECTION * 0.5;
+
+	Parabola superior_i = parabola(x_i, y, x_m, y_max);
+	Parabola superior_f = parabola(x_f, y, x_m, y_max);
+	Parabola entrada_i = parabola(x_i, y, x_a, y - SECTION * 0.1);
+	Parabola entrada_f = parabola(x_f, y, x_g, y - SECTION * 0.1);
+	Parabola ala_i = parabola(x_a, y - SECTION * 0.10, x_b, y + SECTION * 0.1);
+	Parabola ala_f = parabola(x_g, y - SECTION * 0.10, x_e, y + SECTION * 0.1);
+	Parabola pliegue_i = parabola(x_c, y - SECTION * 0.29, x_b, y + SECTION * 0.1);
+	Parabola pliegue_f = parabola(x_d, y - SECTION * 0.29, x_e, y + SECTION * 0.1);
+	Parabola borde_i = parabola(x_c, y - SECTION * 0.3, x_a, y - SECTION * 0.1);
+	Parabola borde_f = parabola(x_d, y - SECTION * 0.3, x_g, y - SECTION * 0.1);
+	Parabola inferior_i = parabola(x_c, y - SECTION * 0.29, x_m, y_min);
+	Parabola inferior_f = parabola(x_d, y - SECTION * 0.29, x_m, y_min);
 
 	COLOR_CONTORNO;
 	GROSOR_CONTORNO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_NARIZ;
-		for(float i = x_i; i <= x_f; i++) {
-			for(float j = y - SECTION * 0.5; j <= y + SECTION * 0.5; j++){
-				float v_s, v_i;
-				if(i < x_i + SECTION * 0.4) {
-					v_s = value_of_curve(x_i, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_i, y, x_i + SECTION * 0.4, y - SECTION * 0.1, i);
-				} else if(i < x_i + SECTION * 0.8){
-					v_s = value_of_curve(x_i, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_i + SECTION * 0.40, y - SECTION * 0.10, x_i + SECTION * 0.8, y + SECTION * 0.1, i);
-					float v_ii = value_of_curve(x_i + SECTION * 1.2, y - SECTION * 0.3, x_i + SECTION * 0.4, y - SECTION * 0.1, i);
-					if(v_ii < j && j < v_i) {
-						COLOR_CONTORNO;
-						p(i, j);
-					} else {
-						COLOR_NARIZ;
-					}
-				} else if(i < x_i + SECTION * 1.2) {
-					v_s = value_of_curve(x_i, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_i + SECTION * 1.2, y - SECTION * 0.29, x_i + SECTION * 0.8, y + SECTION * 0.1, i);
-					float v_ii = value_of_curve(x_i + SECTION * 1.2, y - SECTION * 0.3, x_i + SECTION * 0.4, y - SECTION * 0.1, i);
-					if(v_ii < j && j < v_i) {
-						COLOR_CONTORNO;
-						p(i, j);
-					} else {
-						COLOR_NARIZ;
-					}
-				} else if(i < x_i + SECTION * 1.5) {
-					v_s = value_of_curve(x_i, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_i + SECTION * 1.2, y - SECTION * 0.29, x_i + SECTION * 1.5, y - SECTION * 0.5, i);
-				} else if(i < x_f - SECTION * 1.2) {
-					v_s = value_of_curve(x_f, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_f - SECTION * 1.2, y - SECTION * 0.29, x_i + SECTION * 1.5, y - SECTION * 0.5, i);
-				} else if(i < x_f - SECTION * 0.8) {
-					v_s = value_of_curve(x_f, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_f - SECTION * 1.2, y - SECTION * 0.29, x_f - SECTION * 0.8, y + SECTION * 0.1, i);
-					float v_ii = value_of_curve(x_f - SECTION * 1.2, y - SECTION * 0.3, x_f - SECTION * 0.4, y - SECTION * 0.1, i);
-					if(v_ii < j && j < v_i) {
-						COLOR_CONTORNO;
-						p(i, j);
-					} else {
-						COLOR_NARIZ;
-					}
-				} else if(i < x_f - SECTION * 0.4) {
-					v_s = value_of_curve(x_f, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_f - SECTION * 0.40, y - SECTION * 0.10, x_f - SECTION * 0.8, y + SECTION * 0.1, i);
-					float v_ii = value_of_curve(x_f - SECTION * 1.2, y - SECTION * 0.3, x_f - SECTION * 0.4, y - SECTION * 0.1, i);
+		for(real i = x_i; i <= x_f; i++) {
+			real v_s = curve_at(i < x_m ? superior_i : superior_f, i);
+			real v_i, v_ii = 0;
+			bool borde = false;
+
+			if(i < x_a) {
+				v_i = curve_at(entrada_i, i);
+			} else if(i < x_b) {
+				v_i = curve_at(ala_i, i);
+				v_ii = curve_at(borde_i, i);
+				borde = true;
+			} else if(i < x_c) {
+				v_i = curve_at(pliegue_i, i);
+				v_ii = curve_at(borde_i, i);
+				borde = true;
+			} else if(i < x_m) {
+				v_i = curve_at(inferior_i, i);
+			} else if(i < x_d) {
+				v_i = curve_at(inferior_f, i);
+			} else if(i < x_e) {
+				v_i = curve_at(pliegue_f, i);
+				v_ii = curve_at(borde_f, i);
+				borde = true;
+			} else if(i < x_g) {
+				v_i = curve_at(ala_f, i);
+				v_ii = curve_at(borde_f, i);
+				borde = true;
+			} else {
+				v_i = curve_at(entrada_f, i);
+			}
+
+			for(real j = y_min; j <= y_max; j++){
+				if(borde) {
 					if(v_ii < j && j < v_i) {
 						COLOR_CONTORNO;
 						p(i, j);
 					} else {
 						COLOR_NARIZ;
 					}
-				} else {
-					v_s = value_of_curve(x_f, y, x_i + SECTION * 1.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_f, y, x_f - SECTION * 0.4, y - SECTION * 0.1, i);
 				}
 
 				if(v_i < j && j < v_s){
@@ -361,199 +817,167 @@ void nariz() {
 		curve(x_f - SECTION * 1.2, y - SECTION * 0.29, x_f - SECTION * 0.40, y - SECTION * 0.10, x_f - SECTION * 0.8, y + SECTION * 0.1);
 
 
-	glEnd();
+	end_points();
 }
 
 void ojo_izquierdo() {
-	float x_i = SECTION * 7.6;
-	float x_f = x_i + SECTION * 2.45;
-	float y_i = SECTION * 7;
-	float y_f = SECTION * 7.5;
+	real x_i = SECTION * 7.6;
+	real x_f = x_i + SECTION * 2.45;
+	real y_i = SECTION * 7;
+	real y_f = SECTION * 7.5;
 
 	COLOR_CONTORNO;
 	GROSOR_CONTORNO;
-	glBegin(GL_POINTS);
+	begin_points();
 		p(x_i, y_i); p(x_f, y_f);
 
 		// PESTAÑAS
-		line(x_f, y_f + 3, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f + 2, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f - 2, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f - 3, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-
-		line(x_i, y_i + 3, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i + 2, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i - 2, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i - 3, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-	glEnd();
+		line_band(x_f, y_f, x_f + SECTION * 0.5, y_f - SECTION * 0.1, 7, 1);
+		line_band(x_i, y_i, x_i - SECTION * 0.5, y_i - SECTION * 0.1, 7, 1);
+	end_points();
 	
 	GROSOR_MEDIO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_BLANCO;
 		circle(x_i + SECTION * 1.15, y_f, SECTION * 1.3, true);
-	glEnd();
+	end_points();
 
 	GROSOR_CONTORNO;
 	COLOR_SOMBRA_CLARA;
-	glBegin(GL_POINTS);
-		circleIn(x_i + SECTION * 1.15, y_f, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 1.10, y_f, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 1.05, y_f, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 1.00, y_f, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 0.95, y_f, SECTION * 1.3, -90, 90);
-	glEnd();
+	begin_points();
+		crescent(x_i + SECTION * 1.15, x_i + SECTION * 0.95, y_f, SECTION * 1.3);
+	end_points();
 	
 	GROSOR_CONTORNO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_CONTORNO;
-		circle(x_i + SECTION * 1.15, y_f, SECTION * 1.3);
-		circle(x_i + SECTION * 1.15, y_f, SECTION * 1.35);
+		circle_band(x_i + SECTION * 1.15, y_f, SECTION * 1.325, SECTION * 0.05);
 		circle(x_i + SECTION * 1.35, y_f - SECTION * 0.15, SECTION * 0.5, true);
-	glEnd();
+	end_points();
 
 	GROSOR_MEDIO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_BLANCO;
 		circle(x_i + SECTION * 1.1, y_f - SECTION * 0.15, SECTION * 0.15, true);
 		circle(x_i + SECTION * 1.25, y_f - SECTION * 0.45, SECTION * 0.07, true);
-	glEnd();
+	end_points();
 }
 
 void ojo_derecho() {
-	float x_i = SECTION * 17;
-	float x_f = x_i + SECTION * 2.45;
-	float y_i = SECTION * 7.5;
-	float y_f = SECTION * 7;
+	real x_i = SECTION * 17;
+	real x_f = x_i + SECTION * 2.45;
+	real y_i = SECTION * 7.5;
+	real y_f = SECTION * 7;
 
 	COLOR_CONTORNO;
 	GROSOR_CONTORNO;
 
-	glBegin(GL_POINTS);
+	begin_points();
 		p(x_i, y_i); p(x_f, y_f);
 
 		// PESTAÑAS
-		line(x_f, y_f + 3, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f + 2, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f - 2, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-		line(x_f, y_f - 3, x_f + SECTION * 0.5, y_f - SECTION * 0.1);
-
-		line(x_i, y_i + 3, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i + 2, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i - 2, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-		line(x_i, y_i - 3, x_i - SECTION * 0.5, y_i - SECTION * 0.1);
-	glEnd();
+		line_band(x_f, y_f, x_f + SECTION * 0.5, y_f - SECTION * 0.1, 7, 1);
+		line_band(x_i, y_i, x_i - SECTION * 0.5, y_i - SECTION * 0.1, 7, 1);
+	end_points();
 
 	GROSOR_MEDIO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_BLANCO;
 		circle(x_i + SECTION * 1.3, y_i, SECTION * 1.3, true);
-	glEnd();
+	end_points();
 
 	GROSOR_CONTORNO;
 	COLOR_SOMBRA_CLARA;
-	glBegin(GL_POINTS);
-		circleIn(x_i + SECTION * 1.3, y_i, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 1.25, y_i, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 1.2, y_i, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 1.15, y_i, SECTION * 1.3, -90, 90);
-		circleIn(x_i + SECTION * 1.1, y_i, SECTION * 1.3, -90, 90);
-	glEnd();
+	begin_points();
+		crescent(x_i + SECTION * 1.3, x_i + SECTION * 1.1, y_i, SECTION * 1.3);
+	end_points();
 	
 	GROSOR_CONTORNO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_CONTORNO;
-		circle(x_i + SECTION * 1.3, y_i, SECTION * 1.3);
-		circle(x_i + SECTION * 1.3, y_i, SECTION * 1.35);
+		circle_band(x_i + SECTION * 1.3, y_i, SECTION * 1.325, SECTION * 0.05);
 		circle(x_i + SECTION * 1.1, y_i - SECTION * 0.15, SECTION * 0.5, true);
-	glEnd();
+	end_points();
 	
 	GROSOR_MEDIO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_BLANCO;
 		circle(x_i + SECTION * 0.85, y_i - SECTION * 0.15, SECTION * 0.15, true);
 		circle(x_i + SECTION * 1.05, y_i - SECTION * 0.45, SECTION * 0.07, true);
-	glEnd();
+	end_points();
 }
 
 void boca() {
-	float x_i = SECTION * 7;
-	float x_f = x_i + SECTION * 13;
-	float y = SECTION * 5;
+	real x_i = SECTION * 7;
+	real x_f = x_i + SECTION * 13;
+	real y = SECTION * 5;
+
+	// Limites y curvas del relleno, calculados una vez
+	real x_m = x_i + SECTION * 6.5;
+	real y_min = y - SECTION * 3.05;
+	real y_max = y + SECTION * 0.55;
+
+	Parabola superior_i = parabola(x_i, y, x_m, y + SECTION * 0.5);
+	Parabola superior_f = parabola(x_f, y, x_m, y + SECTION * 0.5);
+	Parabola inferior_i = parabola(x_i, y, x_m, y - SECTION * 3.0);
+	Parabola inferior_f = parabola(x_f, y, x_m, y - SECTION * 3.0);
+
+	// Franjas de sombra entre los dientes, en secciones desde x_i
+	static const double FRANJAS[7][2] = {
+		{1.7, 1.8}, {3.5, 3.7}, {5.1, 5.4}, {6.6, 7.0},
+		{8.3, 8.8}, {9.8, 10.4}, {11.2, 0}
+	};
+	real franjas[7][2];
+	for(int k = 0; k < 7; k++) {
+		franjas[k][0] = x_i + SECTION * FRANJAS[k][0];
+		franjas[k][1] = x_i + SECTION * FRANJAS[k][1];
+	}
+	franjas[6][1] = x_f + 1;
 
 	GROSOR_MEDIO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_BLANCO;
 
-		for(float i = x_i; i <= x_f; i++) {
-			for(float j = (y - SECTION * 3.05); j <= (y + SECTION * 0.55); j++) {
-				float v_s, v_i ;
-				if(i < x_i + SECTION * 6.5){
-					v_s = value_of_curve(x_i, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_i, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-				} else {
-					v_s = value_of_curve(x_f, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-					v_i = value_of_curve(x_f, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-				}
+		for(real i = x_i; i <= x_f; i++) {
+			real v_s = curve_at(i < x_m ? superior_i : superior_f, i);
+			real v_i = curve_at(i < x_m ? inferior_i : inferior_f, i);
+
+			for(real j = y_min; j <= y_max; j++) {
 				if(v_i < j && j < v_s){
 					p(i, j);
 				}
 			}
 		}
-	glEnd();
+	end_points();
 
 	GROSOR_SOMBRA;
 	COLOR_SOMBRA_CLARA;
-	glBegin(GL_POINTS);
-		for(float i = x_i; i <= x_f; i++) {
-			for(float j = (y - SECTION * 3.05); j <= (y + SECTION * 0.55); j++) {
-				float v_s = 0, v_i = 0;
-				if(i < x_i + SECTION * 6.5){
-					if(x_i + SECTION * 1.7 < i && i < x_i + SECTION * 1.8) {
-						v_s = value_of_curve(x_i, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-						v_i = value_of_curve(x_i, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-					} else if(x_i + SECTION * 3.5 < i && i < x_i + SECTION * 3.7) {
-						v_s = value_of_curve(x_i, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-						v_i = value_of_curve(x_i, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-					} else if(x_i + SECTION * 5.1 < i && i < x_i + SECTION * 5.40) {
-						v_s = value_of_curve(x_i, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-						v_i = value_of_curve(x_i, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-					}
-				} else {
-					if(x_i + SECTION * 6.6 < i && i < x_i + SECTION * 7.00) {
-						v_s = value_of_curve(x_f, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-						v_i = value_of_curve(x_f, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-					} else if(x_i + SECTION * 8.3 < i && i < x_i + SECTION * 8.80) {
-						v_s = value_of_curve(x_f, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-						v_i = value_of_curve(x_f, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-					} else if(x_i + SECTION * 9.8 < i && i < x_i + SECTION * 10.4) {
-						v_s = value_of_curve(x_f, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-						v_i = value_of_curve(x_f, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-					} else if(x_i + SECTION * 11.2 < i) {
-						v_s = value_of_curve(x_f, y, x_i + SECTION * 6.5, y + SECTION * 0.5, i);
-						v_i = value_of_curve(x_f, y, x_i + SECTION * 6.5, y - SECTION * 3.0, i);
-					}
-				}
+	begin_points();
+		for(real i = x_i; i <= x_f; i++) {
+			bool sombra = false;
+			for(int k = 0; k < 7; k++) {
+				if(franjas[k][0] < i && i < franjas[k][1]) sombra = true;
+			}
+			if(!sombra) continue;
+
+			real v_s = curve_at(i < x_m ? superior_i : superior_f, i);
+			real v_i = curve_at(i < x_m ? inferior_i : inferior_f, i);
+
+			for(real j = y_min; j <= y_max; j++) {
 				if(v_i < j && j < v_s){
 					p(i, j);
 				}
 			}
 		}
-	glEnd();
+	end_points();
 
 	GROSOR_CONTORNO;
-	glBegin(GL_POINTS);
+	begin_points();
 		COLOR_CONTORNO;
 		p(x_i, y); p(x_f, y);
 
-		curve(x_i, y, x_f, y, x_i + SECTION * 6.5, y + SECTION * 0.5); // LABIO SUPERIOR
-		curve(x_i, y+1, x_f, y+1, x_i + SECTION * 6.5, y + SECTION * 0.55); // LABIO SUPERIOR
-
-		curve(x_i, y, x_f, y, x_i + SECTION * 6.5, y - SECTION * 3.0); // LABIO INFERIOR
-		curve(x_i, y-1, x_f, y-1, x_i + SECTION * 6.5, y - SECTION * 3.05); // LABIO INFERIOR
+		curve_band(x_i, y + 0.5, x_f, y + 0.5, x_i + SECTION * 6.5, y + SECTION * 0.525, 2); // LABIO SUPERIOR
+		curve_band(x_i, y - 0.5, x_f, y - 0.5, x_i + SECTION * 6.5, y - SECTION * 3.025, 2); // LABIO INFERIOR
 
 
 		// DIENTES
@@ -563,131 +987,549 @@ void boca() {
 		line(x_i + SECTION * 7.00, y - SECTION * 2.98, x_i + SECTION * 7.00, y + SECTION * 0.48);
 		line(x_i + SECTION * 8.80, y - SECTION * 2.60, x_i + SECTION * 8.80, y + SECTION * 0.43);
 		line(x_i + SECTION * 10.4, y - SECTION * 1.90, x_i + SECTION * 10.4, y + SECTION * 0.30);
-	glEnd();
+	end_points();
 }
 
 void bigotes_izquierdos() {
-	float x_i_1 = SECTION * 1.60;	float x_f_1 = x_i_1 + SECTION * 4.9;
-	float y_i_1 = SECTION * 7.80;	float y_f_1 = y_i_1 - SECTION * 1.8;
+	real x_i_1 = SECTION * 1.60;	real x_f_1 = x_i_1 + SECTION * 4.9;
+	real y_i_1 = SECTION * 7.80;	real y_f_1 = y_i_1 - SECTION * 1.8;
 
-	float x_i_2 = SECTION * 1.00;	float x_f_2 = x_i_2 + SECTION * 5.0;
-	float y_i_2 = SECTION * 5.50;	float y_f_2 = y_i_2 + SECTION * 0.0;
+	real x_i_2 = SECTION * 1.00;	real x_f_2 = x_i_2 + SECTION * 5.0;
+	real y_i_2 = SECTION * 5.50;	real y_f_2 = y_i_2 + SECTION * 0.0;
 
-	float x_i_3 = SECTION * 2.00;	float x_f_3 = x_i_3 + SECTION * 4.3;
-	float y_i_3 = SECTION * 3.50;	float y_f_3 = y_i_3 + SECTION * 1.0;
+	real x_i_3 = SECTION * 2.00;	real x_f_3 = x_i_3 + SECTION * 4.3;
+	real y_i_3 = SECTION * 3.50;	real y_f_3 = y_i_3 + SECTION * 1.0;
 
 	COLOR_SOMBRA;
 	GROSOR_SOMBRA;
-	glBegin(GL_POINTS);
-		line(x_i_1, y_i_1 - SECTION * 0.5, x_f_1 - 1, y_f_1 + 2);
-		line(x_i_1, y_i_1 - SECTION * 0.5, x_f_1, y_f_1 + 1);
-		line(x_i_1, y_i_1 - SECTION * 0.5, x_f_1, y_f_1);
-		line(x_i_1, y_i_1 - SECTION * 0.5, x_f_1, y_f_1 - 1);
-		line(x_i_1, y_i_1 - SECTION * 0.5, x_f_1 - 1, y_f_1 - 2);
-
-		line(x_i_2 + SECTION * 0.1, y_i_2 - SECTION * 0.2, x_f_2 - 1, y_f_2 + 2);
-		line(x_i_2 + SECTION * 0.1, y_i_2 - SECTION * 0.2, x_f_2, y_f_2 + 1);
-		line(x_i_2 + SECTION * 0.1, y_i_2 - SECTION * 0.2, x_f_2, y_f_2);
-		line(x_i_2 + SECTION * 0.1, y_i_2 - SECTION * 0.2, x_f_2, y_f_2 - 1);
-		line(x_i_2 + SECTION * 0.1, y_i_2 - SECTION * 0.2, x_f_2 - 1, y_f_2 - 2);
-
-		line(x_i_3 + SECTION * 0.2, y_i_3 - SECTION * 0.3, x_f_3 - 1, y_f_3 + 2);
-		line(x_i_3 + SECTION * 0.2, y_i_3 - SECTION * 0.3, x_f_3, y_f_3 + 1);
-		line(x_i_3 + SECTION * 0.2, y_i_3 - SECTION * 0.3, x_f_3, y_f_3);
-		line(x_i_3 + SECTION * 0.2, y_i_3 - SECTION * 0.3, x_f_3, y_f_3 - 1);
-		line(x_i_3 + SECTION * 0.2, y_i_3 - SECTION * 0.3, x_f_3 - 1, y_f_3 - 2);
-	glEnd();
+	begin_points();
+		line_band(x_i_1, y_i_1 - SECTION * 0.5, x_f_1, y_f_1, 1, 5);
+
+		line_band(x_i_2 + SECTION * 0.1, y_i_2 - SECTION * 0.2, x_f_2, y_f_2, 1, 5);
+
+		line_band(x_i_3 + SECTION * 0.2, y_i_3 - SECTION * 0.3, x_f_3, y_f_3, 1, 5);
+	end_points();
 
 	COLOR_CONTORNO;
 	GROSOR_CONTORNO;
-	glBegin(GL_POINTS);
+	begin_points();
 		p(x_i_1, y_i_1); p(x_f_1, y_f_1);
 		p(x_i_2, y_i_2); p(x_f_2, y_f_2);
 		p(x_i_3, y_i_3); p(x_f_3, y_f_3);
 
-		line(x_i_1, y_i_1, x_f_1 - 1, y_f_1 + 2);
-		line(x_i_1, y_i_1, x_f_1, y_f_1 + 1);
-		line(x_i_1, y_i_1, x_f_1, y_f_1);
-		line(x_i_1, y_i_1, x_f_1, y_f_1 - 1);
-		line(x_i_1, y_i_1, x_f_1 - 1, y_f_1 - 2);
+		line_band(x_i_1, y_i_1, x_f_1, y_f_1, 1, 5);
 
-		line(x_i_2, y_i_2, x_f_2 - 1, y_f_2 + 2);
-		line(x_i_2, y_i_2, x_f_2, y_f_2 + 1);
-		line(x_i_2, y_i_2, x_f_2, y_f_2);
-		line(x_i_2, y_i_2, x_f_2, y_f_2 - 1);
-		line(x_i_2, y_i_2, x_f_2 - 1, y_f_2 - 2);
+		line_band(x_i_2, y_i_2, x_f_2, y_f_2, 1, 5);
 
-		line(x_i_3, y_i_3, x_f_3 - 1, y_f_3 + 2);
-		line(x_i_3, y_i_3, x_f_3, y_f_3 + 1);
-		line(x_i_3, y_i_3, x_f_3, y_f_3);
-		line(x_i_3, y_i_3, x_f_3, y_f_3 - 1);
-		line(x_i_3, y_i_3, x_f_3 - 1, y_f_3 - 2);
-	glEnd();
+		line_band(x_i_3, y_i_3, x_f_3, y_f_3, 1, 5);
+	end_points();
 }
 
 void bigotes_derechos() {
-	float x_i_1 = SECTION * 20.5;	float x_f_1 = x_i_1 + SECTION * 4.5;
-	float y_i_1 = SECTION * 06.0;	float y_f_1 = y_i_1 + SECTION * 1.8;
+	real x_i_1 = SECTION * 20.5;	real x_f_1 = x_i_1 + SECTION * 4.5;
+	real y_i_1 = SECTION * 06.0;	real y_f_1 = y_i_1 + SECTION * 1.8;
 
-	float x_i_2 = SECTION * 21.0;	float x_f_2 = x_i_2 + SECTION * 5.0;
-	float y_i_2 = SECTION * 05.5;	float y_f_2 = y_i_2 + SECTION * 0.0;
+	real x_i_2 = SECTION * 21.0;	real x_f_2 = x_i_2 + SECTION * 5.0;
+	real y_i_2 = SECTION * 05.5;	real y_f_2 = y_i_2 + SECTION * 0.0;
 
-	float x_i_3 = SECTION * 21.2;	float x_f_3 = x_i_3 + SECTION * 3.8;
-	float y_i_3 = SECTION * 04.6;	float y_f_3 = y_i_3 - SECTION * 0.2;
+	real x_i_3 = SECTION * 21.2;	real x_f_3 = x_i_3 + SECTION * 3.8;
+	real y_i_3 = SECTION * 04.6;	real y_f_3 = y_i_3 - SECTION * 0.2;
 
 	COLOR_SOMBRA;
 	GROSOR_SOMBRA;
-	glBegin(GL_POINTS);
-		line(x_i_1 + 1, y_i_1 + 2, x_f_1, y_f_1 - SECTION * 0.5);
-		line(x_i_1, y_i_1 + 1, x_f_1, y_f_1 - SECTION * 0.5);
-		line(x_i_1, y_i_1, x_f_1, y_f_1 - SECTION * 0.5);
-		line(x_i_1, y_i_1 - 1, x_f_1, y_f_1 - SECTION * 0.5);
-		line(x_i_1 + 1, y_i_1 - 2, x_f_1, y_f_1 - SECTION * 0.5);
-
-		line(x_i_2 + 1, y_i_2 + 2, x_f_2 - SECTION * 0.1, y_f_2 - SECTION * 0.2);
-		line(x_i_2, y_i_2 + 1, x_f_2 - SECTION * 0.1, y_f_2 - SECTION * 0.2);
-		line(x_i_2, y_i_2, x_f_2 - SECTION * 0.1, y_f_2 - SECTION * 0.2);
-		line(x_i_2, y_i_2 - 1, x_f_2 - SECTION * 0.1, y_f_2 - SECTION * 0.2);
-		line(x_i_2 + 1, y_i_2 - 2, x_f_2 - SECTION * 0.1, y_f_2 - SECTION * 0.2);
-
-		line(x_i_3 + 1, y_i_3 + 2, x_f_3 - SECTION * 0.2, y_f_3 - SECTION * 0.3);
-		line(x_i_3, y_i_3 + 1, x_f_3 - SECTION * 0.2, y_f_3 - SECTION * 0.3);
-		line(x_i_3, y_i_3, x_f_3 - SECTION * 0.2, y_f_3 - SECTION * 0.3);
-		line(x_i_3, y_i_3 - 1, x_f_3 - SECTION * 0.2, y_f_3 - SECTION * 0.3);
-		line(x_i_3 + 1, y_i_3 - 2, x_f_3 - SECTION * 0.2, y_f_3 - SECTION * 0.3);
-	glEnd();
+	begin_points();
+		line_band(x_i_1, y_i_1, x_f_1, y_f_1 - SECTION * 0.5, 5, 1);
+
+		line_band(x_i_2, y_i_2, x_f_2 - SECTION * 0.1, y_f_2 - SECTION * 0.2, 5, 1);
+
+		line_band(x_i_3, y_i_3, x_f_3 - SECTION * 0.2, y_f_3 - SECTION * 0.3, 5, 1);
+	end_points();
 
 	COLOR_CONTORNO;
 	GROSOR_CONTORNO;
-	glBegin(GL_POINTS);
+	begin_points();
 		p(x_i_1, y_i_1); p(x_f_1, y_f_1);
 		p(x_i_2, y_i_2); p(x_f_2, y_f_2);
 		p(x_i_3, y_i_3); p(x_f_3, y_f_3);
 
-		line(x_i_1 + 1, y_i_1 + 2, x_f_1, y_f_1);
-		line(x_i_1, y_i_1 + 1, x_f_1, y_f_1);
-		line(x_i_1, y_i_1, x_f_1, y_f_1);
-		line(x_i_1, y_i_1 - 1, x_f_1, y_f_1);
-		line(x_i_1 + 1, y_i_1 - 2, x_f_1, y_f_1);
+		line_band(x_i_1, y_i_1, x_f_1, y_f_1, 5, 1);
+
+		line_band(x_i_2, y_i_2, x_f_2, y_f_2, 5, 1);
+
+		line_band(x_i_3, y_i_3, x_f_3, y_f_3, 5, 1);
+	end_points();
+}
+
+/***********************************************************************
+	INSTANCING FUNCTIONS
+***********************************************************************/
+
+void dibujar_totoro() {
+	pelos();
+	nariz();
+	ojo_izquierdo();
+	ojo_derecho();
+	boca();
+	bigotes_derechos();
+	bigotes_izquierdos();
+}
+
+/*
+	La geometria completa (sin puntillismo) solo depende de SECTION, asi
+	que se genera una vez por SECTION y la comparten todos los hilos.
+*/
+struct Geometria {
+	std::once_flag lista;
+	Nube nube;
+};
+
+void capture(Nube& nube, int seccion) {
+	int anterior = SECTION;
+
+	SECTION = seccion;
+	captura = &nube;
+	dibujar_totoro();
+	captura = NULL;
+	SECTION = anterior;
+
+	nube.x_min = nube.y_min = 0;
+	nube.x_max = nube.y_max = 0;
+	for(size_t i = 0; i < nube.puntos.size(); i++) {
+		const Punto& punto = nube.puntos[i];
+		float r = punto.size / 2;
+		if(i == 0 || punto.x - r < nube.x_min) nube.x_min = punto.x - r;
+		if(i == 0 || punto.y - r < nube.y_min) nube.y_min = punto.y - r;
+		if(i == 0 || punto.x + r > nube.x_max) nube.x_max = punto.x + r;
+		if(i == 0 || punto.y + r > nube.y_max) nube.y_max = punto.y + r;
+	}
+}
+
+std::map<int, Geometria> geometrias;
+std::mutex geometrias_mutex;
+
+const Nube& geometry(int seccion) {
+	Geometria* geometria;
+	{
+		std::lock_guard<std::mutex> lock(geometrias_mutex);
+		geometria = &geometrias[seccion];
+	}
+
+	std::call_once(geometria->lista, [&]() {
+		capture(geometria->nube, seccion);
+	});
+
+	return geometria->nube;
+}
+
+/*
+	Generador propio en lugar de rand(), que es compartido entre hilos:
+	cada trabajo obtiene el mismo puntillismo para la misma semilla.
+*/
+unsigned int next_random(unsigned int& estado) {
+	estado = estado * 1103515245 + 12345;
+	return (estado / 65536) % 32768;
+}
+
+Nube stipple(const Nube& base, int granulado, unsigned int semilla) {
+	Nube nube;
+	nube.x_min = base.x_min;
+	nube.y_min = base.y_min;
+	nube.x_max = base.x_max;
+	nube.y_max = base.y_max;
+	nube.puntos.reserve(base.puntos.size() / granulado + 1);
+
+	unsigned int estado = semilla;
+	for(size_t i = 0; i < base.puntos.size(); i++) {
+		if((next_random(estado)%100)%granulado == 0)
+			nube.puntos.push_back(base.puntos[i]);
+	}
+
+	return nube;
+}
+
+/*
+	Copia la nube en un arreglo de vertices y la parte en tramos de
+	puntos consecutivos con el mismo grosor y color. Se conserva el
+	orden original porque cada parte se dibuja encima de la anterior.
+*/
+void build_runs(Nube& nube) {
+	nube.vertices.resize(nube.puntos.size() * 2);
+	nube.tramos.clear();
+
+	for(size_t i = 0; i < nube.puntos.size(); i++) {
+		const Punto& punto = nube.puntos[i];
+		nube.vertices[i * 2 + 0] = punto.x;
+		nube.vertices[i * 2 + 1] = punto.y;
+
+		if(nube.tramos.empty() || nube.tramos.back().size != punto.size || nube.tramos.back().color != punto.color) {
+			Tramo tramo = {punto.size, punto.color, (int)i, 0};
+			nube.tramos.push_back(tramo);
+		}
+		nube.tramos.back().cantidad++;
+	}
+}
+
+/*
+	La nube con puntillismo se genera una sola vez por cada
+	(SECTION, GRANULADO, semilla) y se reutiliza para todas las copias.
+*/
+std::map<std::tuple<int, int, unsigned int>, Nube> nubes;
+
+const Nube& base_cloud(unsigned int semilla) {
+	std::tuple<int, int, unsigned int> clave(SECTION, GRANULADO, semilla);
+	std::map<std::tuple<int, int, unsigned int>, Nube>::iterator it = nubes.find(clave);
+	if(it != nubes.end()) return it->second;
+
+	Nube& nube = nubes[clave] = stipple(geometry(SECTION), GRANULADO, semilla);
+	build_runs(nube);
+	return nube;
+}
+
+std::vector<Instancia> crowd(int cantidad, float ancho, float alto) {
+	std::vector<Instancia> instancias;
+
+	for(int i = 0; i < cantidad; i++) {
+		Instancia instancia;
+		// Algunas copias quedan fuera de la ventana a proposito
+		instancia.x = (rand() % 1200 - 100) / 1000.0 * ancho;
+		instancia.y = (rand() % 1200 - 100) / 1000.0 * alto;
+		instancia.escala = 0.1 + (rand() % 250) / 1000.0;
+		instancia.R = 0.7 + (rand() % 300) / 1000.0;
+		instancia.G = 0.7 + (rand() % 300) / 1000.0;
+		instancia.B = 0.7 + (rand() % 300) / 1000.0;
+		instancias.push_back(instancia);
+	}
+
+	return instancias;
+}
+
+bool visible(const Nube& nube, const Instancia& instancia, float ancho, float alto) {
+	return instancia.x + nube.x_max * instancia.escala >= 0
+		&& instancia.y + nube.y_max * instancia.escala >= 0
+		&& instancia.x + nube.x_min * instancia.escala <= ancho
+		&& instancia.y + nube.y_min * instancia.escala <= alto;
+}
+
+int draw_instances(const Nube& nube, const std::vector<Instancia>& instancias, float ancho, float alto) {
+	int dibujadas = 0;
+	float colores[COLORES][3];
+	palette(paleta, colores);
+
+	// Los vertices se envian una vez; cada copia solo cambia la matriz y el color de cada tramo
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, nube.vertices.data());
+
+	for(size_t i = 0; i < instancias.size(); i++) {
+		const Instancia& instancia = instancias[i];
+		if(!visible(nube, instancia, ancho, alto)) continue;
+
+		glPushMatrix();
+		glTranslatef(instancia.x, instancia.y, 0);
+		glScalef(instancia.escala, instancia.escala, 1);
+
+		float size = -1;
+		for(size_t j = 0; j < nube.tramos.size(); j++) {
+			const Tramo& tramo = nube.tramos[j];
+			if(tramo.size != size) {
+				size = tramo.size;
+				glPointSize(std::max(1.0f, size * instancia.escala));
+			}
+			const float* rgb = colores[tramo.color];
+			glColor3f(rgb[0] * instancia.R, rgb[1] * instancia.G, rgb[2] * instancia.B);
+			glDrawArrays(GL_POINTS, tramo.inicio, tramo.cantidad);
+		}
+
+		glPopMatrix();
+		dibujadas++;
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	return dibujadas;
+}
+
+/***********************************************************************
+	CPU FUNCTIONS
+***********************************************************************/
+
+struct Lienzo {
+	int ancho, alto;
+	std::vector<unsigned char> pixeles;	// RGB, la fila 0 es la inferior como en OpenGL
+};
+
+void clear_canvas(Lienzo& lienzo, int ancho, int alto, const float color[3]) {
+	lienzo.ancho = ancho;
+	lienzo.alto = alto;
+	lienzo.pixeles.resize((size_t)ancho * alto * 3);
+	for(size_t i = 0; i < (size_t)ancho * alto; i++) {
+		lienzo.pixeles[i * 3 + 0] = color[0] * 255;
+		lienzo.pixeles[i * 3 + 1] = color[1] * 255;
+		lienzo.pixeles[i * 3 + 2] = color[2] * 255;
+	}
+}
+
+/*
+	Igual que GL_POINTS sin antialiasing: un cuadrado de 'size' pixeles
+	centrado en (x, y).
+*/
+void splat(Lienzo& lienzo, float x, float y, float size, float R, float G, float B) {
+	int lado = size < 1 ? 1 : (int)(size + 0.5);
+	int x_i = (int)floor(x - lado / 2.0 + 0.5);
+	int y_i = (int)floor(y - lado / 2.0 + 0.5);
+
+	for(int Y = std::max(y_i, 0); Y < std::min(y_i + lado, lienzo.alto); Y++) {
+		for(int X = std::max(x_i, 0); X < std::min(x_i + lado, lienzo.ancho); X++) {
+			unsigned char* pixel = &lienzo.pixeles[((size_t)Y * lienzo.ancho + X) * 3];
+			pixel[0] = R * 255;
+			pixel[1] = G * 255;
+			pixel[2] = B * 255;
+		}
+	}
+}
+
+/*
+	Con 'granulado' > 1 el puntillismo se aplica al dibujar, con el mismo
+	generador que stipple(), asi no hace falta copiar la nube completa.
+*/
+int draw_instances_cpu(Lienzo& lienzo, const Nube& nube, const std::vector<Instancia>& instancias,
+	int granulado = 1, unsigned int semilla = 0) {
+	int dibujadas = 0;
+	float colores[COLORES][3];
+	palette(paleta, colores);
+
+	for(size_t i = 0; i < instancias.size(); i++) {
+		const Instancia& instancia = instancias[i];
+		if(!visible(nube, instancia, lienzo.ancho, lienzo.alto)) continue;
+
+		unsigned int estado = semilla;
+		for(size_t j = 0; j < nube.puntos.size(); j++) {
+			if(granulado > 1 && (next_random(estado)%100)%granulado != 0) continue;
+
+			const Punto& punto = nube.puntos[j];
+			const float* rgb = colores[punto.color];
+			splat(lienzo,
+				instancia.x + punto.x * instancia.escala,
+				instancia.y + punto.y * instancia.escala,
+				punto.size * instancia.escala,
+				rgb[0] * instancia.R, rgb[1] * instancia.G, rgb[2] * instancia.B);
+		}
+		dibujadas++;
+	}
+
+	return dibujadas;
+}
+
+bool write_ppm(const Lienzo& lienzo, const char* ruta) {
+	std::ofstream archivo(ruta, std::ios::binary);
+	if(!archivo) return false;
+
+	archivo << "P6\n" << lienzo.ancho << " " << lienzo.alto << "\n255\n";
+	for(int Y = lienzo.alto - 1; Y >= 0; Y--) {
+		archivo.write((const char*)&lienzo.pixeles[(size_t)Y * lienzo.ancho * 3], (std::streamsize)lienzo.ancho * 3);
+	}
+
+	return archivo.good();
+}
+
+void report(const char* backend, int total, int dibujadas, double segundos) {
+	std::cout << backend << ": " << total << " instancias (" << dibujadas << " visibles) en "
+		<< segundos * 1000 << " ms - " << (segundos > 0 ? dibujadas / segundos : 0) << " instancias dibujadas/s\n";
+}
+
+/***********************************************************************
+	BATCH FUNCTIONS
+***********************************************************************/
+
+struct Trabajo {
+	int section, granulado, paleta;
+	unsigned int semilla;
+	std::string salida;
+	double segundos;
+	bool ok;
+};
+
+struct Rango {
+	int desde, hasta, paso;
+};
 
-		line(x_i_2 + 1, y_i_2 + 2, x_f_2, y_f_2);
-		line(x_i_2, y_i_2 + 1, x_f_2, y_f_2);
-		line(x_i_2, y_i_2, x_f_2, y_f_2);
-		line(x_i_2, y_i_2 - 1, x_f_2, y_f_2);
-		line(x_i_2 + 1, y_i_2 - 2, x_f_2, y_f_2);
+// 'desde', 'desde:hasta' o 'desde:hasta:paso'
+bool parse_range(const char* texto, Rango& rango) {
+	char separador;
+	std::istringstream entrada(texto);
 
-		line(x_i_3 + 1, y_i_3 + 2, x_f_3, y_f_3);
-		line(x_i_3, y_i_3 + 1, x_f_3, y_f_3);
-		line(x_i_3, y_i_3, x_f_3, y_f_3);
-		line(x_i_3, y_i_3 - 1, x_f_3, y_f_3);
-		line(x_i_3 + 1, y_i_3 - 2, x_f_3, y_f_3);
-	glEnd();
+	if(!(entrada >> rango.desde)) return false;
+	rango.hasta = rango.desde;
+	rango.paso = 1;
+
+	if(entrada >> separador && (separador != ':' || !(entrada >> rango.hasta))) return false;
+	if(entrada >> separador && (separador != ':' || !(entrada >> rango.paso))) return false;
+
+	return rango.paso > 0 && rango.desde <= rango.hasta && entrada.eof();
+}
+
+bool valid_job(const Trabajo& trabajo) {
+	return trabajo.section > 0 && trabajo.section <= SECTION_MAXIMA && trabajo.granulado > 0
+		&& trabajo.paleta >= 0 && trabajo.paleta < TOTAL_PALETAS;
+}
+
+// Una linea por trabajo: 'section granulado semilla paleta salida.ppm'
+bool read_manifest(const char* ruta, std::vector<Trabajo>& trabajos) {
+	std::ifstream archivo(ruta);
+	if(!archivo) return false;
+
+	std::string linea;
+	while(std::getline(archivo, linea)) {
+		std::istringstream campos(linea);
+		Trabajo trabajo;
+
+		if(linea.empty() || linea[0] == '#') continue;
+		if(!(campos >> trabajo.section >> trabajo.granulado >> trabajo.semilla >> trabajo.paleta >> trabajo.salida)
+			|| !valid_job(trabajo)) {
+			std::cerr << "Linea invalida en " << ruta << ": " << linea << '\n';
+			return false;
+		}
+		trabajos.push_back(trabajo);
+	}
+
+	return true;
+}
+
+void sweep(const Rango& secciones, const Rango& granulados, const Rango& semillas,
+	const Rango& paletas, const std::string& directorio, std::vector<Trabajo>& trabajos) {
+	for(int s = secciones.desde; s <= secciones.hasta; s += secciones.paso) {
+		for(int g = granulados.desde; g <= granulados.hasta; g += granulados.paso) {
+			for(int r = semillas.desde; r <= semillas.hasta; r += semillas.paso) {
+				for(int c = paletas.desde; c <= paletas.hasta; c += paletas.paso) {
+					std::ostringstream salida;
+					salida << directorio << "/totoro_s" << s << "_g" << g << "_r" << r << "_p" << c << ".ppm";
+
+					Trabajo trabajo;
+					trabajo.section = s;
+					trabajo.granulado = g;
+					trabajo.semilla = r;
+					trabajo.paleta = c;
+					trabajo.salida = salida.str();
+					trabajos.push_back(trabajo);
+				}
+			}
+		}
+	}
+}
+
+void render_job(Trabajo& trabajo) {
+	std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+	SECTION = trabajo.section;
+	GRANULADO = trabajo.granulado;
+	paleta = trabajo.paleta;
+
+	std::vector<Instancia> unica(1, Instancia{0, 0, 1, 1, 1, 1});
+
+	float colores[COLORES][3];
+	palette(paleta, colores);
+
+	Lienzo lienzo;
+	clear_canvas(lienzo, WIDTH, HEIGHT, colores[FONDO]);
+	draw_instances_cpu(lienzo, geometry(SECTION), unica, GRANULADO, trabajo.semilla);
+	trabajo.ok = write_ppm(lienzo, trabajo.salida.c_str());
+
+	std::chrono::duration<double> tiempo = std::chrono::steady_clock::now() - inicio;
+	trabajo.segundos = tiempo.count();
+}
+
+/*
+	Cada hilo toma el siguiente trabajo libre hasta que no quede ninguno,
+	asi los trabajos grandes (SECTION alto) no dejan nucleos sin usar.
+*/
+bool run_batch(std::vector<Trabajo>& trabajos) {
+	unsigned int hilos = std::max(1u, std::thread::hardware_concurrency());
+	hilos = std::min<size_t>(hilos, trabajos.size());
+
+	std::atomic<size_t> siguiente(0);
+	std::atomic<int> fallidos(0);
+	std::mutex salida_mutex;
+	std::vector<std::thread> trabajadores;
+
+	std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+	for(unsigned int h = 0; h < hilos; h++) {
+		trabajadores.push_back(std::thread([&]() {
+			for(size_t i = siguiente++; i < trabajos.size(); i = siguiente++) {
+				Trabajo& trabajo = trabajos[i];
+				render_job(trabajo);
+				if(!trabajo.ok) fallidos++;
+
+				std::lock_guard<std::mutex> lock(salida_mutex);
+				std::cout << "[" << i + 1 << "/" << trabajos.size() << "] " << trabajo.salida
+					<< (trabajo.ok ? "" : " (no se pudo escribir)") << " - "
+					<< trabajo.segundos * 1000 << " ms\n";
+			}
+		}));
+	}
+
+	for(size_t h = 0; h < trabajadores.size(); h++) {
+		trabajadores[h].join();
+	}
+
+	std::chrono::duration<double> tiempo = std::chrono::steady_clock::now() - inicio;
+	std::cout << trabajos.size() << " trabajos en " << tiempo.count() << " s con " << hilos << " hilos - "
+		<< trabajos.size() / tiempo.count() << " trabajos/s, " << geometrias.size() << " geometrias\n";
+
+	return fallidos == 0;
+}
+
+/***********************************************************************
+	BENCHMARK FUNCTIONS
+***********************************************************************/
+
+// FNV-1a de los bits de cada punto, para comparar nubes entre compilaciones
+uint64_t cloud_hash(const Nube& nube) {
+	uint64_t hash = 14695981039346656037ULL;
+
+	for(size_t i = 0; i < nube.puntos.size(); i++) {
+		const Punto& punto = nube.puntos[i];
+		uint32_t campos[4];
+		memcpy(&campos[0], &punto.x, 4);
+		memcpy(&campos[1], &punto.y, 4);
+		memcpy(&campos[2], &punto.size, 4);
+		campos[3] = punto.color;
+
+		const unsigned char* bytes = (const unsigned char*)campos;
+		for(size_t j = 0; j < sizeof(campos); j++) {
+			hash ^= bytes[j];
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	return hash;
+}
+
+/*
+	Genera la geometria 'repeticiones' veces sin pasar por la cache.
+	Compilar con y sin -DGEOMETRIA_FIJA para comparar los dos nucleos.
+*/
+void benchmark_geometry(int repeticiones) {
+	Nube nube;
+	std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < repeticiones; i++) {
+		nube = Nube();
+		capture(nube, SECTION);
+	}
+
+	std::chrono::duration<double> tiempo = std::chrono::steady_clock::now() - inicio;
+	std::cout << "Geometria " << GEOMETRIA << ", SECTION " << SECTION << ": "
+		<< nube.puntos.size() << " puntos, " << tiempo.count() * 1000 / repeticiones
+		<< " ms por generacion, hash " << std::hex << cloud_hash(nube) << std::dec << '\n';
 }
 
 /***********************************************************************
 	GL FUNCTIONS
 ***********************************************************************/
 
+std::vector<Instancia> multitud;
+unsigned int semilla = 1;
+
 void myInit (void) {
 	COLOR_FONDO;
 	glMatrixMode(GL_PROJECTION); 
@@ -698,13 +1540,19 @@ void myInit (void) {
 void myDisplay (void) {
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	pelos();
-	nariz();
-	ojo_izquierdo();
-	ojo_derecho();
-	boca();
-	bigotes_derechos();
-	bigotes_izquierdos();
+	if(multitud.empty()) {
+		dibujar_totoro();
+	} else {
+		const Nube& nube = base_cloud(semilla);
+		float ancho = glutGet(GLUT_WINDOW_WIDTH);
+		float alto = glutGet(GLUT_WINDOW_HEIGHT);
+
+		std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+		int dibujadas = draw_instances(nube, multitud, ancho, alto);
+		glFinish();
+		std::chrono::duration<double> tiempo = std::chrono::steady_clock::now() - inicio;
+		report("GL", multitud.size(), dibujadas, tiempo.count());
+	}
 
 	glFlush(); 
 }
@@ -717,6 +1565,88 @@ void myResize (int w, int h) {
 }
 
 int main (int argc, char** argv) {
+	int cantidad = 0;
+	const char* salida_cpu = NULL;
+	const char* manifiesto = NULL;
+	bool barrido = false;
+	int repeticiones = 0;
+	std::string directorio = ".";
+	Rango secciones = {SECTION, SECTION, 1};
+	Rango granulados = {GRANULADO, GRANULADO, 1};
+	Rango semillas = {1, 1, 1};
+	Rango paletas = {0, 0, 1};
+
+	for(int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool valor = i + 1 < argc;
+		bool ok = true;
+
+		if(arg == "--barrido") barrido = true;
+		else if(arg == "--benchmark" && valor) repeticiones = atoi(argv[++i]);
+		else if(arg == "--multitud" && valor) cantidad = atoi(argv[++i]);
+		else if(arg == "--cpu" && valor) salida_cpu = argv[++i];
+		else if(arg == "--lote" && valor) manifiesto = argv[++i];
+		else if(arg == "--salida" && valor) directorio = argv[++i];
+		else if(arg == "--section" && valor) ok = parse_range(argv[++i], secciones);
+		else if(arg == "--granulado" && valor) ok = parse_range(argv[++i], granulados);
+		else if(arg == "--semilla" && valor) ok = parse_range(argv[++i], semillas);
+		else if(arg == "--paleta" && valor) ok = parse_range(argv[++i], paletas);
+
+		if(!ok || secciones.desde <= 0 || secciones.hasta > SECTION_MAXIMA || granulados.desde <= 0 || semillas.desde < 0
+			|| paletas.desde < 0 || paletas.hasta >= TOTAL_PALETAS) {
+			std::cerr << "Valor invalido: " << arg << " " << argv[i] << '\n';
+			return 1;
+		}
+	}
+
+	SECTION = secciones.desde;
+	GRANULADO = granulados.desde;
+	paleta = paletas.desde;
+	semilla = semillas.desde;
+	srand(semilla);
+
+	if(repeticiones > 0) {
+		benchmark_geometry(repeticiones);
+		return 0;
+	}
+
+	if(manifiesto || barrido) {
+		std::vector<Trabajo> trabajos;
+		if(manifiesto && !read_manifest(manifiesto, trabajos)) {
+			std::cerr << "No se pudo leer " << manifiesto << '\n';
+			return 1;
+		}
+		if(barrido) sweep(secciones, granulados, semillas, paletas, directorio, trabajos);
+		return run_batch(trabajos) ? 0 : 1;
+	}
+
+	if(salida_cpu) {
+		const Nube& nube = base_cloud(semilla);
+		if(cantidad > 0) {
+			multitud = crowd(cantidad, WIDTH, HEIGHT);
+		} else {
+			Instancia unica = {0, 0, 1, 1, 1, 1};
+			multitud.push_back(unica);
+		}
+
+		float colores[COLORES][3];
+		palette(paleta, colores);
+
+		Lienzo lienzo;
+		clear_canvas(lienzo, WIDTH, HEIGHT, colores[FONDO]);
+
+		std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+		int dibujadas = draw_instances_cpu(lienzo, nube, multitud);
+		std::chrono::duration<double> tiempo = std::chrono::steady_clock::now() - inicio;
+		report("CPU", multitud.size(), dibujadas, tiempo.count());
+
+		if(!write_ppm(lienzo, salida_cpu)) {
+			std::cerr << "No se pudo escribir " << salida_cpu << '\n';
+			return 1;
+		}
+		return 0;
+	}
+
 	glutInit(&argc, argv);
 	glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB); 
 	glutInitWindowSize(WIDTH, HEIGHT); 
@@ -725,6 +1655,10 @@ int main (int argc, char** argv) {
 	glutDisplayFunc(myDisplay); 
 	glutReshapeFunc(myResize); 
 	myInit(); 
+	if(cantidad > 0) {
+		base_cloud(semilla);
+		multitud = crowd(cantidad, WIDTH, HEIGHT);
+	}
 	glutMainLoop(); 
 	
 	return 0;